@@ -0,0 +1,71 @@
+#ifndef ARENA_ALLOCATOR_H
+#define ARENA_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+
+namespace utils {
+	//! WHERE PARSE TABLE ROWS GET THEIR MEMORY FROM. IMPLEMENT IT OVER YOUR OWN ARENA AND HAND IT TO
+	//! PredictiveTable, THE ARENA MUST OUTLIVE THE TABLE AND EVERY COPY OF IT.
+	class MemoryResource {
+		public:
+			virtual ~MemoryResource() {}
+
+			virtual void* allocate(const size_t bytes, const size_t alignment) = 0;
+
+			virtual void deallocate(void* pointer, const size_t bytes, const size_t alignment) = 0;
+	};
+
+	//! THE DEFAULT RESOURCE, PLAIN operator new AND operator delete
+	class HeapResource : public MemoryResource {
+		public:
+			void* allocate(const size_t bytes, const size_t) {
+				return ::operator new(bytes);
+			}
+
+			void deallocate(void* pointer, const size_t, const size_t) {
+				::operator delete(pointer);
+			}
+
+			static HeapResource& getInstance() {
+				static HeapResource instance;
+				return instance;
+			}
+	};
+
+	//! STANDARD ALLOCATOR THAT FORWARDS TO A MemoryResource, SO CONTAINERS CAN BE PLACED IN A CALLER'S ARENA
+	template <typename T>
+	class ArenaAllocator {
+		public:
+			typedef T value_type;
+
+			MemoryResource* resource;
+
+			ArenaAllocator() : resource(&HeapResource::getInstance()) {}
+
+			explicit ArenaAllocator(MemoryResource* resourceInput) : resource(resourceInput) {}
+
+			template <typename U>
+			ArenaAllocator(const ArenaAllocator<U>& other) : resource(other.resource) {}
+
+			T* allocate(const size_t count) {
+				return static_cast<T*>(resource->allocate(count * sizeof(T), alignof(T)));
+			}
+
+			void deallocate(T* pointer, const size_t count) {
+				resource->deallocate(pointer, count * sizeof(T), alignof(T));
+			}
+
+			template <typename U>
+			bool operator==(const ArenaAllocator<U>& other) const {
+				return resource == other.resource;
+			}
+
+			template <typename U>
+			bool operator!=(const ArenaAllocator<U>& other) const {
+				return resource != other.resource;
+			}
+	};
+};
+
+#endif //ARENA_ALLOCATOR_H
@@ -68,6 +68,55 @@ class FileManager {
 			return fileContent;
 		}
 
+		bool fileExists(const std::string& absFilePath) const {
+			std::ifstream file(absFilePath);
+			return file.good();
+		}
+
+		//! RESOLVES relativePath AGAINST THE DIRECTORY OF baseFilePath, ABSOLUTE PATHS ARE RETURNED AS-IS
+		std::string resolvePath(const std::string& baseFilePath, const std::string& relativePath) const {
+			if (StringUtils::startsWith(relativePath, PATH_SEPARATOR) || (relativePath.length() > 1 && relativePath[1] == ':')) {
+				return relativePath;
+			}
+
+			size_t index = baseFilePath.find_last_of(PATH_SEPARATOR);
+			if (index == std::string::npos) {
+				return normalizePath(relativePath);
+			}
+			return normalizePath(baseFilePath.substr(0, index + 1) + relativePath);
+		}
+
+		//! COLLAPSES "." AND ".." SEGMENTS SO ONE FILE ALWAYS MAPS TO ONE PATH
+		std::string normalizePath(const std::string& path) const {
+			const std::string separator = PATH_SEPARATOR;
+			std::vector<std::string> segments;
+
+			size_t start = 0;
+			while (start <= path.length()) {
+				size_t end = path.find(separator, start);
+				if (end == std::string::npos) {
+					end = path.length();
+				}
+
+				std::string segment = path.substr(start, end - start);
+				if (segment == ".." && !segments.empty() && segments.back() != ".." && !segments.back().empty()) {
+					segments.pop_back();
+				} else if (segment != "." && !(segment.empty() && !segments.empty())) {
+					segments.push_back(segment);
+				}
+				start = end + separator.length();
+			}
+
+			std::string normalized;
+			for (size_t i = 0; i < segments.size(); i++) {
+				if (i > 0) {
+					normalized += separator;
+				}
+				normalized += segments[i];
+			}
+			return normalized;
+		}
+
 		static FileManager& getInstance() {
 			static FileManager instance;
 			return instance;
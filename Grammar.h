@@ -10,13 +10,47 @@
 #include <set>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <utility>
+#include <algorithm>
 
 #include "FileManager.h"
 #include "StringUtils.h"
 #include "Helpers.h"
+#include "MemoryUsage.h"
+#include "HashUtils.h"
 
 using namespace utils;
 
+//! MODULE DIRECTIVES IN THE ::= FORMAT: @include "relative/or/absolute/path" AND @start <Symbol>
+#define INCLUDE_DIRECTIVE "@include"
+#define START_DIRECTIVE "@start"
+
+//! ONE PARSED GRAMMAR FILE, BEFORE IT IS MERGED WITH THE MODULES IT INCLUDES
+struct GrammarModule {
+	std::string path;
+
+	uint64_t hash;
+
+	std::vector<std::string> includes;
+
+	//! EMPTY UNLESS THE MODULE DECLARES ONE WITH @start
+	std::string startSymbol;
+
+	//! KEPT IN FILE ORDER SO DUPLICATE LHS CAN BE REPORTED WHILE MERGING
+	std::vector<std::pair<std::string, std::vector<std::vector<std::string>>>> productions;
+
+	std::set<std::string> terminals;
+
+	std::set<std::string> nonTerminals;
+
+	//! PROBLEMS FOUND WHILE READING THIS FILE, REPORTED AGAIN BY EVERY GRAMMAR THAT MERGES IT
+	std::vector<std::string> errors;
+
+	GrammarModule() : hash(0) {}
+};
 
 class Grammar {
 	private:
@@ -30,11 +64,16 @@ class Grammar {
 
 		std::string startSymbol;
 
+		uint64_t identity;
+
+		std::map<std::string, uint64_t> moduleHashes;
+
+		std::vector<std::string> errors;
+
 	public:
-		explicit Grammar (const std::string& absFilePath, const bool isFile = false) {
-			auto fileStream = FileManager::getInstance().getStream(absFilePath, OpenMode::READ);
+		explicit Grammar (const std::string& absFilePath, const bool isFile = false) : identity(0) {
 			this->grammar = (isFile) ? FileManager::getInstance().getFileContent(grammar) : grammar;
-			processGrammar(fileStream);
+			processGrammar(absFilePath);
 		}
 
 		bool isTerminal(const std::string& symbol) const {
@@ -65,6 +104,38 @@ class Grammar {
 			return startSymbol;
 		}
 
+		//! HASH OF THE START SYMBOL AND THE MERGED PRODUCTIONS, EQUAL FOR GRAMMARS THAT PARSE THE SAME LANGUAGE THE SAME WAY
+		uint64_t getIdentity() const {
+			return identity;
+		}
+
+		//! CONTENT HASH OF THE ROOT FILE AND OF EVERY MODULE IT PULLED IN, AS THEY WERE WHEN LOADED
+		std::map<std::string, uint64_t> getModuleHashes() const {
+			return moduleHashes;
+		}
+
+		//! EVERY PROBLEM FOUND WHILE LOADING AND MERGING THE MODULES, ALSO WRITTEN TO std::cerr
+		const std::vector<std::string>& getErrors() const {
+			return errors;
+		}
+
+		//! AN INVALID GRAMMAR IS ONLY WHAT COULD BE SALVAGED, DO NOT BUILD A TABLE FROM IT
+		bool isValid() const {
+			return errors.empty();
+		}
+
+		MemoryUsage getMemoryUsage() const {
+			MemoryUsage usage = MemoryUtils::usageOf(grammar);
+			usage += MemoryUtils::usageOf(productions);
+			usage += MemoryUtils::usageOf(terminals);
+			usage += MemoryUtils::usageOf(nonTerminals);
+			usage += MemoryUtils::usageOf(startSymbol);
+			usage += MemoryUtils::usageOf(errors);
+			usage += MemoryUtils::usageOf(moduleHashes);
+			usage += MemoryUsage(0, sizeof(identity));
+			return usage;
+		}
+
 		void printGrammar() const {
 			std::cout << "\n=== Grammar ===\n";
 
@@ -125,38 +196,248 @@ class Grammar {
 		}
 
 	private:
-		void processGrammar(const std::shared_ptr<std::fstream>& fileStream) {
-			std::string line;
+		//! THE ROOT FILE IS READ FRESH EVERY TIME SO A GRAMMAR CAN BE REBUILT AFTER ITS FILE CHANGED
+		void processGrammar(const std::string& absFilePath) {
+			std::shared_ptr<const GrammarModule> root = loadModule(FileManager::getInstance().normalizePath(absFilePath));
+			std::map<std::string, std::shared_ptr<const GrammarModule>> modules = loadIncludes(root);
+			mergeModules(root, modules);
+		}
+
+		//! LOADS THE INCLUDE GRAPH ONE LEVEL AT A TIME, EVERY MODULE OF A LEVEL ON ITS OWN THREAD
+		static std::map<std::string, std::shared_ptr<const GrammarModule>> loadIncludes(const std::shared_ptr<const GrammarModule>& root) {
+			std::map<std::string, std::shared_ptr<const GrammarModule>> modules;
+			modules[root->path] = root;
+
+			std::vector<std::string> pending = root->includes;
+			while (!pending.empty()) {
+				std::vector<std::string> batch;
+				for (size_t i = 0; i < pending.size(); i++) {
+					if (modules.find(pending[i]) == modules.end() && std::find(batch.begin(), batch.end(), pending[i]) == batch.end()) {
+						batch.push_back(pending[i]);
+					}
+				}
+
+				std::vector<std::future<std::shared_ptr<const GrammarModule>>> loads;
+				for (size_t i = 0; i < batch.size(); i++) {
+					loads.push_back(std::async(std::launch::async, &Grammar::loadModule, batch[i]));
+				}
+
+				pending.clear();
+				for (size_t i = 0; i < batch.size(); i++) {
+					std::shared_ptr<const GrammarModule> module = loads[i].get();
+					modules[batch[i]] = module;
+					pending.insert(pending.end(), module->includes.begin(), module->includes.end());
+				}
+			}
+
+			return modules;
+		}
+
+		//! MERGES DEPTH-FIRST IN INCLUDE ORDER, SO THE RESULT DOES NOT DEPEND ON WHICH LOAD FINISHED FIRST
+		void mergeModules(const std::shared_ptr<const GrammarModule>& root, const std::map<std::string, std::shared_ptr<const GrammarModule>>& modules) {
+			std::map<std::string, std::string> definedIn;
+			std::set<std::string> visited;
+			std::vector<std::shared_ptr<const GrammarModule>> order;
+			orderModules(root, modules, visited, order);
+
+			for (size_t i = 0; i < order.size(); i++) {
+				const GrammarModule& module = *order[i];
+				moduleHashes[module.path] = module.hash;
+
+				for (size_t j = 0; j < module.errors.size(); j++) {
+					report(module.errors[j]);
+				}
+
+				for (size_t j = 0; j < module.productions.size(); j++) {
+					const std::string& lhs = module.productions[j].first;
+					if (definedIn.find(lhs) != definedIn.end()) {
+						report("Error: duplicate production for <" + lhs + "> in " + module.path + ", first defined in " + definedIn[lhs]);
+						continue;
+					}
+					definedIn[lhs] = module.path;
+					productions.insert(module.productions[j]);
+				}
+
+				terminals.insert(module.terminals.begin(), module.terminals.end());
+				nonTerminals.insert(module.nonTerminals.begin(), module.nonTerminals.end());
+
+				if (!module.startSymbol.empty()) {
+					if (!startSymbol.empty() && startSymbol != module.startSymbol) {
+						report("Error: conflicting start symbol <" + module.startSymbol + "> in " + module.path + ", already declared as <" + startSymbol + ">");
+						continue;
+					}
+					startSymbol = module.startSymbol;
+				}
+			}
+
+			//! WITHOUT AN EXPLICIT @start THE FIRST PRODUCTION OF THE ROOT FILE IS THE START SYMBOL
+			if (startSymbol.empty() && !root->productions.empty()) {
+				startSymbol = root->productions.front().first;
+			}
+
+			if (startSymbol.empty()) {
+				report("Error: no start symbol for " + root->path + ", add @start or a production to it");
+			} else if (productions.find(startSymbol) == productions.end()) {
+				report("Error: start symbol <" + startSymbol + "> has no production");
+			}
+
+			reportUndefinedSymbols();
+
+			identity = computeIdentity();
+		}
+
+		//! A RIGHT-HAND SIDE SYMBOL THAT IS NEITHER A TERMINAL NOR DEFINED WOULD MAKE THE TABLE FAIL ON ITS ROW
+		void reportUndefinedSymbols() {
+			std::map<std::string, std::vector<std::vector<std::string>>>::const_iterator it;
+			for (it = productions.begin(); it != productions.end(); ++it) {
+				std::set<std::string> reported;
+				for (size_t i = 0; i < it->second.size(); i++) {
+					const std::vector<std::string>& rhs = it->second[i];
+					for (size_t j = 0; j < rhs.size(); j++) {
+						if (!isTerminal(rhs[j]) && productions.find(rhs[j]) == productions.end() && reported.insert(rhs[j]).second) {
+							report("Error: <" + rhs[j] + "> is used by <" + it->first + "> but has no production");
+						}
+					}
+				}
+			}
+		}
+
+		void report(const std::string& message) {
+			errors.push_back(message);
+			std::cerr << message << std::endl;
+		}
+
+		//! EVERY LIST IS PREFIXED WITH ITS LENGTH AND EVERY SYMBOL WITH ITS KIND, SO <S> ::= x y AND <S> ::= x | y,
+		//! OR <x> AND x, NEVER HASH THE SAME
+		uint64_t computeIdentity() const {
+			uint64_t hash = HashUtils::fnv1a(startSymbol);
+			hash = HashUtils::combine(hash, productions.size());
+
+			std::map<std::string, std::vector<std::vector<std::string>>>::const_iterator it;
+			for (it = productions.begin(); it != productions.end(); ++it) {
+				hash = HashUtils::fnv1a(it->first, hash);
+				hash = HashUtils::combine(hash, it->second.size());
+
+				for (size_t i = 0; i < it->second.size(); i++) {
+					const std::vector<std::string>& rhs = it->second[i];
+					hash = HashUtils::combine(hash, rhs.size());
+
+					for (size_t j = 0; j < rhs.size(); j++) {
+						hash = HashUtils::combine(hash, isTerminal(rhs[j]) ? 'T' : 'N');
+						hash = HashUtils::fnv1a(rhs[j], hash);
+						hash = HashUtils::combine(hash, rhs[j].length());
+					}
+				}
+			}
+			return hash;
+		}
 
-			if (!fileStream) {
-				std::cerr << "Unable to open file!" << std::endl;
+		static void orderModules(const std::shared_ptr<const GrammarModule>& module, const std::map<std::string, std::shared_ptr<const GrammarModule>>& modules, std::set<std::string>& visited, std::vector<std::shared_ptr<const GrammarModule>>& order) {
+			if (!visited.insert(module->path).second) {
 				return;
 			}
 
-			bool isFirstProduction = true;
+			order.push_back(module);
+			for (size_t i = 0; i < module->includes.size(); i++) {
+				orderModules(modules.at(module->includes[i]), modules, visited, order);
+			}
+		}
+
+		struct ModuleCache {
+			std::mutex lock;
+			std::map<std::string, std::shared_ptr<const GrammarModule>> modules;
+		};
 
-			while (std::getline(*fileStream, line)) {
+		static ModuleCache& getModuleCache() {
+			static ModuleCache cache;
+			return cache;
+		}
+
+		//! REUSES THE CACHED MODULE WHEN THE FILE CONTENT HASH IS UNCHANGED
+		static std::shared_ptr<const GrammarModule> loadModule(const std::string& absFilePath) {
+			if (!FileManager::getInstance().fileExists(absFilePath)) {
+				//! HASHED LIKE AN EMPTY FILE, WHICH IS WHAT getFileLines() RETURNS FOR IT, SO WATCHERS SEE NO CHANGE
+				//! UNTIL THE FILE ACTUALLY APPEARS
+				GrammarModule missing;
+				missing.path = absFilePath;
+				missing.hash = HashUtils::fnv1a(std::vector<std::string>());
+				missing.errors.push_back("Error: Unable to open grammar module " + absFilePath);
+				return std::make_shared<GrammarModule>(missing);
+			}
+
+			std::vector<std::string> lines = FileManager::getInstance().getFileLines(absFilePath);
+			uint64_t hash = HashUtils::fnv1a(lines);
+
+			ModuleCache& cache = getModuleCache();
+			{
+				std::lock_guard<std::mutex> guard(cache.lock);
+				std::map<std::string, std::shared_ptr<const GrammarModule>>::const_iterator it = cache.modules.find(absFilePath);
+				if (it != cache.modules.end() && it->second->hash == hash) {
+					return it->second;
+				}
+			}
+
+			std::shared_ptr<const GrammarModule> module = std::make_shared<GrammarModule>(parseModule(absFilePath, lines, hash));
+
+			std::lock_guard<std::mutex> guard(cache.lock);
+			cache.modules[absFilePath] = module;
+			return module;
+		}
+
+		static GrammarModule parseModule(const std::string& absFilePath, const std::vector<std::string>& lines, const uint64_t hash) {
+			GrammarModule module;
+			module.path = absFilePath;
+			module.hash = hash;
+
+			for (size_t i = 0; i < lines.size(); i++) {
+				std::string line = StringUtils::trim(lines[i]);
 				if (StringUtils::startsWith(line, "//") || line.empty()) {
 					continue;
 				}
+
+				if (StringUtils::startsWith(line, INCLUDE_DIRECTIVE)) {
+					std::string includePath = parseDirectivePath(line.substr(std::string(INCLUDE_DIRECTIVE).length()));
+					module.includes.push_back(FileManager::getInstance().resolvePath(absFilePath, includePath));
+					continue;
+				}
+
+				if (StringUtils::startsWith(line, START_DIRECTIVE)) {
+					module.startSymbol = parseNonTerminal(line.substr(std::string(START_DIRECTIVE).length()));
+					if (module.startSymbol.empty()) {
+						module.errors.push_back("Error: " + std::string(START_DIRECTIVE) + " expects a <Symbol> on line " + std::to_string(i + 1) + " of " + absFilePath);
+					}
+					continue;
+				}
+
 				std::pair<std::string, std::string> parts = StringUtils::splitStr(line, "::=");
-				std::string lhs = parseLHS(parts.first);
-				std::vector<std::vector<std::string>> rhs = parseRHS(parts.second);
-				productions.insert(std::make_pair(lhs, rhs));
-				if (isFirstProduction) {
-					startSymbol = lhs;
-					isFirstProduction = false;
+				if (parseNonTerminal(parts.first).empty()) {
+					module.errors.push_back("Error: expected <Symbol> ::= ... on line " + std::to_string(i + 1) + " of " + absFilePath);
+					continue;
 				}
+
+				std::string lhs = parseLHS(parts.first, module);
+				std::vector<std::vector<std::string>> rhs = parseRHS(parts.second, module);
+				module.productions.push_back(std::make_pair(lhs, rhs));
+			}
+
+			return module;
+		}
+
+		static std::string parseDirectivePath(const std::string& argument) {
+			std::string path = StringUtils::trim(argument);
+			if (path.length() >= 2 && path[0] == '"' && path[path.length() - 1] == '"') {
+				path = path.substr(1, path.length() - 2);
 			}
+			return path;
 		}
 
-		std::string parseLHS(const std::string& lhs) {
+		static std::string parseLHS(const std::string& lhs, GrammarModule& module) {
 			std::string nonTerminal = parseNonTerminal(lhs);
-			nonTerminals.insert(nonTerminal);
+			module.nonTerminals.insert(nonTerminal);
 			return nonTerminal;
 		}
 
-		std::vector<std::vector<std::string>> parseRHS(const std::string& rhs) {
+		static std::vector<std::vector<std::string>> parseRHS(const std::string& rhs, GrammarModule& module) {
 			std::vector<std::vector<std::string>> rule;
 			std::vector<std::string> current;
 
@@ -179,7 +460,7 @@ class Grammar {
 					std::string nonTerminal = parseNonTerminal(rhs.substr(i));
 
 					if (nonTerminal.empty()) {
-						std::cerr << "Error: Failed to parse non-terminal at position " << i << std::endl;
+						module.errors.push_back("Error: Failed to parse non-terminal at position " + std::to_string(i) + " in " + module.path);
 						return std::vector<std::vector<std::string>>();
 					}
 
@@ -189,7 +470,7 @@ class Grammar {
 					std::string terminal = parseTerminal(rhs.substr(i));
 
 					if (terminal.empty()) {
-						std::cerr << "Error: Failed to parse terminal at position " << i << std::endl;
+						module.errors.push_back("Error: Failed to parse terminal at position " + std::to_string(i) + " in " + module.path);
 						return std::vector<std::vector<std::string>>();
 					}
 
@@ -199,7 +480,7 @@ class Grammar {
 					} 
 					
 					current.push_back(terminal);
-					terminals.insert(terminal);
+					module.terminals.insert(terminal);
 					i += terminal.length();
 				}
 			}
@@ -0,0 +1,275 @@
+#ifndef GRAMMAR_REGISTRY_H
+#define GRAMMAR_REGISTRY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <exception>
+
+#include "FileManager.h"
+#include "HashUtils.h"
+#include "PredictiveTable.h"
+
+using namespace utils;
+
+//! ONE IMMUTABLE BUILD OF A GRAMMAR FILE AND EVERYTHING IT INCLUDES
+struct GrammarVersion {
+	size_t generation;
+
+	//! CONTENT HASH OF EVERY MODULE FILE THE VERSION WAS BUILT FROM
+	std::map<std::string, uint64_t> moduleHashes;
+
+	std::shared_ptr<const PredictiveTable> table;
+
+	GrammarVersion() : generation(0) {}
+};
+
+//! THE CURRENT VERSION OF ONE GRAMMAR. READERS CALL acquire() WITHOUT TAKING ANY LOCK AND KEEP THE
+//! VERSION ALIVE THROUGH THE RETURNED shared_ptr, SO A PARSE ALWAYS FINISHES ON THE TABLE IT STARTED WITH.
+//! THE REGISTRY PUBLISHES A NEW VERSION BY SWAPPING current AND WAITING FOR BOTH READER COUNTERS TO DRAIN
+//! BEFORE IT DROPS ITS OWN REFERENCE (TWO-COUNTER RCU).
+class GrammarHandle {
+	private:
+		std::string path;
+
+		bool lazy;
+
+		std::atomic<std::shared_ptr<const GrammarVersion>*> current;
+
+		std::atomic<size_t> epoch;
+
+		mutable std::atomic<size_t> readers[2];
+
+		//! SERIALIZES PUBLISHERS, NEVER TAKEN BY acquire()
+		std::mutex publishLock;
+
+		//! MODULE HASHES OF THE LAST BUILD THAT FAILED, SO A BROKEN FILE IS NOT REBUILT ON EVERY POLL
+		std::map<std::string, uint64_t> rejectedHashes;
+
+	public:
+		GrammarHandle(const std::string& absFilePath, const bool lazyInput)
+		: path(absFilePath), lazy(lazyInput), current(nullptr), epoch(0) {
+			readers[0].store(0);
+			readers[1].store(0);
+		}
+
+		~GrammarHandle() {
+			delete current.load();
+		}
+
+		//! EMPTY UNTIL THE FIRST SUCCESSFUL BUILD
+		std::shared_ptr<const GrammarVersion> acquire() const {
+			std::atomic<size_t>& counter = readers[epoch.load() & 1];
+
+			counter.fetch_add(1);
+			std::shared_ptr<const GrammarVersion>* box = current.load();
+			std::shared_ptr<const GrammarVersion> version = box ? *box : std::shared_ptr<const GrammarVersion>();
+			counter.fetch_sub(1);
+
+			return version;
+		}
+
+		std::string getPath() const {
+			return path;
+		}
+
+		//! REBUILDS WHEN ANY MODULE FILE CHANGED, RETURNS TRUE IF A NEW VERSION WAS PUBLISHED
+		bool reloadIfChanged() {
+			std::lock_guard<std::mutex> guard(publishLock);
+
+			std::shared_ptr<const GrammarVersion> previous = acquire();
+			if (previous && !hasChanged(previous->moduleHashes)) {
+				return false;
+			}
+			if (!rejectedHashes.empty() && !hasChanged(rejectedHashes)) {
+				return false;
+			}
+
+			std::shared_ptr<GrammarVersion> next = build(previous ? previous->generation + 1 : 1);
+			if (!next->table) {
+				rejectedHashes = next->moduleHashes;
+				return false;
+			}
+
+			rejectedHashes.clear();
+			publish(next);
+			return true;
+		}
+
+	private:
+		//! A VERSION WITHOUT A TABLE MEANS THE BUILD FAILED. NOTHING THROWS OUT OF HERE, A HALF-SAVED FILE MUST
+		//! NOT TAKE DOWN THE WATCHER THREAD OR THE CALLER OF add()
+		std::shared_ptr<GrammarVersion> build(const size_t generation) const {
+			std::shared_ptr<GrammarVersion> version = std::make_shared<GrammarVersion>();
+			version->generation = generation;
+
+			try {
+				Grammar grammar(path);
+				version->moduleHashes = grammar.getModuleHashes();
+
+				if (!grammar.isValid()) {
+					std::cerr << "Error: grammar " << path << " has " << grammar.getErrors().size() << " error(s), keeping the previous version" << std::endl;
+					return version;
+				}
+
+				std::shared_ptr<PredictiveTable> table = std::make_shared<PredictiveTable>(grammar, lazy);
+
+				//! AN EAGER TABLE BUILDS ALL ROWS ON ITS FIRST LOOKUP, DO IT HERE INSTEAD OF IN THE FIRST READER
+				if (!lazy) {
+					table->getParseRow(grammar.getStartSymbol());
+				}
+
+				version->table = table;
+			} catch (const std::exception& e) {
+				std::cerr << "Error: failed to build grammar " << path << " (" << e.what() << "), keeping the previous version" << std::endl;
+
+				//! THE ROOT FILE ALONE STILL LETS reloadIfChanged() SKIP THE SAME BROKEN CONTENT ON THE NEXT POLL
+				if (version->moduleHashes.empty()) {
+					version->moduleHashes[path] = HashUtils::fnv1a(FileManager::getInstance().getFileLines(path));
+				}
+			}
+			return version;
+		}
+
+		//! MUST BE CALLED WITH publishLock HELD
+		void publish(const std::shared_ptr<const GrammarVersion>& version) {
+			std::shared_ptr<const GrammarVersion>* previous = current.exchange(new std::shared_ptr<const GrammarVersion>(version));
+
+			//! A READER MAY HAVE READ THE EPOCH LONG BEFORE IT INCREMENTED ITS COUNTER, SO IT CAN SIT ON EITHER
+			//! COUNTER. EACH ONE IS DRAINED AFTER THE SWAP, AND THE FLIP IN FRONT OF EACH DRAIN SENDS NEW
+			//! READERS TO THE OTHER COUNTER SO THEY CANNOT KEEP IT BUSY.
+			waitForReaders(epoch.fetch_add(1));
+			waitForReaders(epoch.fetch_add(1));
+
+			delete previous;
+		}
+
+		void waitForReaders(const size_t drainingEpoch) const {
+			while (readers[drainingEpoch & 1].load() != 0) {
+				std::this_thread::yield();
+			}
+		}
+
+		static bool hasChanged(const std::map<std::string, uint64_t>& moduleHashes) {
+			std::map<std::string, uint64_t>::const_iterator it;
+			for (it = moduleHashes.begin(); it != moduleHashes.end(); ++it) {
+				if (HashUtils::fnv1a(FileManager::getInstance().getFileLines(it->first)) != it->second) {
+					return true;
+				}
+			}
+			return false;
+		}
+};
+
+//! WATCHES REGISTERED GRAMMAR FILES ON A BACKGROUND THREAD AND HOT-SWAPS THEIR TABLES WHEN THEY CHANGE
+class GrammarRegistry {
+	private:
+		//! GUARDS handles AND THE WATCHER STATE, READERS HOLD A GrammarHandle AND NEVER TOUCH IT
+		std::mutex lock;
+
+		std::map<std::string, std::shared_ptr<GrammarHandle>> handles;
+
+		std::thread watcher;
+
+		std::condition_variable wakeUp;
+
+		bool stopping;
+
+	public:
+		GrammarRegistry() : stopping(false) {}
+
+		~GrammarRegistry() {
+			stop();
+		}
+
+		//! BUILDS THE FIRST VERSION SYNCHRONOUSLY, REGISTERING THE SAME PATH TWICE RETURNS THE SAME HANDLE
+		std::shared_ptr<GrammarHandle> add(const std::string& absFilePath, const bool lazy = false) {
+			std::shared_ptr<GrammarHandle> handle;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				std::map<std::string, std::shared_ptr<GrammarHandle>>::iterator it = handles.find(absFilePath);
+				if (it != handles.end()) {
+					return it->second;
+				}
+				handle = std::make_shared<GrammarHandle>(absFilePath, lazy);
+				handles[absFilePath] = handle;
+			}
+
+			handle->reloadIfChanged();
+			return handle;
+		}
+
+		//! EMPTY IF THE PATH WAS NEVER REGISTERED
+		std::shared_ptr<GrammarHandle> get(const std::string& absFilePath) {
+			std::lock_guard<std::mutex> guard(lock);
+			std::map<std::string, std::shared_ptr<GrammarHandle>>::const_iterator it = handles.find(absFilePath);
+			return it != handles.end() ? it->second : std::shared_ptr<GrammarHandle>();
+		}
+
+		//! RETURNS THE NUMBER OF GRAMMARS THAT GOT A NEW VERSION
+		size_t reloadAll() {
+			std::vector<std::shared_ptr<GrammarHandle>> snapshot;
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				std::map<std::string, std::shared_ptr<GrammarHandle>>::const_iterator it;
+				for (it = handles.begin(); it != handles.end(); ++it) {
+					snapshot.push_back(it->second);
+				}
+			}
+
+			size_t reloaded = 0;
+			for (size_t i = 0; i < snapshot.size(); i++) {
+				if (snapshot[i]->reloadIfChanged()) {
+					reloaded++;
+				}
+			}
+			return reloaded;
+		}
+
+		void start(const std::chrono::milliseconds interval) {
+			std::lock_guard<std::mutex> guard(lock);
+			if (watcher.joinable()) {
+				return;
+			}
+
+			stopping = false;
+			watcher = std::thread(&GrammarRegistry::watch, this, interval);
+		}
+
+		void stop() {
+			{
+				std::lock_guard<std::mutex> guard(lock);
+				stopping = true;
+			}
+			wakeUp.notify_all();
+
+			if (watcher.joinable()) {
+				watcher.join();
+			}
+		}
+
+	private:
+		void watch(const std::chrono::milliseconds interval) {
+			std::unique_lock<std::mutex> guard(lock);
+			while (!stopping) {
+				wakeUp.wait_for(guard, interval);
+				if (stopping) {
+					break;
+				}
+
+				guard.unlock();
+				reloadAll();
+				guard.lock();
+			}
+		}
+};
+
+#endif //GRAMMAR_REGISTRY_H
@@ -0,0 +1,87 @@
+#ifndef HASH_UTILS_H
+#define HASH_UTILS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace utils {
+	struct Hash128 {
+		uint64_t low;
+		uint64_t high;
+
+		Hash128() : low(0), high(0) {}
+
+		Hash128(const uint64_t lowInput, const uint64_t highInput) : low(lowInput), high(highInput) {}
+
+		bool operator==(const Hash128& other) const {
+			return low == other.low && high == other.high;
+		}
+
+		bool operator<(const Hash128& other) const {
+			return high < other.high || (high == other.high && low < other.low);
+		}
+	};
+
+	class HashUtils {
+		public:
+			static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+			static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+			static uint64_t fnv1a(const std::string& str, uint64_t hash = FNV_OFFSET_BASIS) {
+				for (size_t i = 0; i < str.length(); i++) {
+					hash ^= static_cast<unsigned char>(str[i]);
+					hash *= FNV_PRIME;
+				}
+				return hash;
+			}
+
+			//! 64-BIT FINALIZER FROM MURMURHASH3, SPREADS EVERY INPUT BIT OVER THE LOW BITS USED BY %
+			static uint64_t mix(uint64_t hash) {
+				hash ^= hash >> 33;
+				hash *= 0xff51afd7ed558ccdULL;
+				hash ^= hash >> 33;
+				hash *= 0xc4ceb9fe1a85ec53ULL;
+				hash ^= hash >> 33;
+				return hash;
+			}
+
+			//! FOLDS A NUMBER (A COUNT, A TAG) INTO A RUNNING HASH
+			static uint64_t combine(const uint64_t hash, const uint64_t value) {
+				return (hash ^ mix(value)) * FNV_PRIME;
+			}
+
+			//! MIXES IN A SEPARATOR AFTER EVERY STRING SO {"ab", "c"} AND {"a", "bc"} DIFFER
+			static uint64_t fnv1a(const std::vector<std::string>& strs, uint64_t hash = FNV_OFFSET_BASIS) {
+				for (size_t i = 0; i < strs.size(); i++) {
+					hash = fnv1a(strs[i], hash);
+					hash ^= 0xff;
+					hash *= FNV_PRIME;
+				}
+				return hash;
+			}
+
+			//! TWO INDEPENDENT LANES (FNV-1a AND A MULTIPLY-ADD) FINALIZED TOGETHER, ONE PASS OVER THE BYTES
+			static Hash128 hash128(const std::vector<std::string>& strs, const uint64_t seed = 0) {
+				uint64_t first = FNV_OFFSET_BASIS ^ seed;
+				uint64_t second = mix(seed + 1);
+				uint64_t length = 0;
+
+				for (size_t i = 0; i < strs.size(); i++) {
+					const std::string& str = strs[i];
+					for (size_t j = 0; j < str.length(); j++) {
+						const unsigned char c = static_cast<unsigned char>(str[j]);
+						first = (first ^ c) * FNV_PRIME;
+						second = (second + c + 1) * 0x9e3779b97f4a7c15ULL;
+					}
+					first = (first ^ 0xff) * FNV_PRIME;
+					second = (second + 0x100) * 0x9e3779b97f4a7c15ULL;
+					length += str.length() + 1;
+				}
+
+				return Hash128(mix(first ^ length), mix(second + first));
+			}
+	};
+};
+
+#endif //HASH_UTILS_H
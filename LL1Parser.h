@@ -5,77 +5,166 @@
 #ifndef LL1_PARSER_H
 #define LL1_PARSER_H
 
-#include <stack>
 #include <string>
 #include <iostream>
 #include <vector>
 #include <map>
+#include <memory>
 
 #include "PredictiveTable.h"
+#include "ParseResultCache.h"
 
 class LL1Parser {
 	private:
-		PredictiveTable table;
+		std::shared_ptr<const PredictiveTable> table;
 		std::vector<std::string> tokens;
+		size_t peakStackDepth;
+		MemoryUsage peakStackUsage;
+		std::vector<std::string> diagnostics;
+		std::shared_ptr<ParseResultCache> resultCache;
 
 	public:
 		LL1Parser(const std::vector<std::string>& tokensInput, const PredictiveTable& tableInput)
-		: table(tableInput), tokens(tokensInput) {}
+		: table(std::make_shared<PredictiveTable>(tableInput)), tokens(tokensInput), peakStackDepth(0) {}
+
+		//! SHARES THE TABLE INSTEAD OF COPYING IT, THE PARSER KEEPS IT ALIVE UNTIL IT IS DESTROYED
+		LL1Parser(const std::vector<std::string>& tokensInput, const std::shared_ptr<const PredictiveTable>& tableInput)
+		: table(tableInput), tokens(tokensInput), peakStackDepth(0) {}
+
+		//! IDENTICAL TOKEN STREAMS OVER THE SAME GRAMMAR ARE ANSWERED FROM THE CACHE WITHOUT PARSING
+		void setResultCache(const std::shared_ptr<ParseResultCache>& cache) {
+			resultCache = cache;
+		}
+
+		//! ERRORS REPORTED BY THE LAST CALL TO parse(), ALSO WRITTEN TO std::cerr
+		const std::vector<std::string>& getDiagnostics() const {
+			return diagnostics;
+		}
+
+		//! DEEPEST PARSE STACK REACHED BY THE LAST CALL TO parse()
+		size_t getPeakStackDepth() const {
+			return peakStackDepth;
+		}
+
+		//! BYTES HELD BY THE PARSE STACK WHEN IT WAS LARGEST, ITS SPARE CAPACITY INCLUDED
+		MemoryUsage getPeakStackUsage() const {
+			return peakStackUsage;
+		}
+
+		std::map<std::string, MemoryUsage> getMemoryUsageByComponent() const {
+			std::map<std::string, MemoryUsage> components = table->getMemoryUsageByComponent();
+			components["tokens"] = MemoryUtils::usageOf(tokens);
+			components["parseStack"] = peakStackUsage;
+			return components;
+		}
+
+		MemoryUsage getMemoryUsage() const {
+			return MemoryUtils::sum(getMemoryUsageByComponent());
+		}
+
+		void printMemoryUsage() const {
+			PredictiveTable::printMemoryUsage(getMemoryUsageByComponent());
+			std::cout << "Peak parse stack depth: " << peakStackDepth << "\n";
+		}
 
 		bool parse() {
-			std::stack<std::string> parseStack;
-			parseStack.push("$");
-			parseStack.push(table.getStartSymbol());
+			diagnostics.clear();
+			if (!resultCache) {
+				return run();
+			}
+
+			ParseResultCache::Key key = ParseResultCache::makeKey(tokens, table->getGrammarIdentity());
+			std::shared_ptr<const ParseResult> cached = resultCache->lookup(key);
+			if (cached) {
+				peakStackDepth = 0;
+				peakStackUsage = MemoryUsage();
+				for (size_t k = 0; k < cached->diagnostics.size(); ++k) {
+					report(cached->diagnostics[k]);
+				}
+				return cached->accepted;
+			}
+
+			ParseResult result;
+			result.accepted = run();
+			result.diagnostics = diagnostics;
+			resultCache->store(key, result);
+			return result.accepted;
+		}
+
+	private:
+		//! THE STACK AND THE INPUT ARE SYMBOL IDS, SO EVERY STEP IS AN INT COMPARE OR A ROW INDEX
+		bool run() {
+			const TerminalClassifier& classifier = table->getClassifier();
+			std::vector<int> parseStack;
+			peakStackDepth = 0;
+			peakStackUsage = MemoryUsage();
+
+			parseStack.push_back(classifier.classify("$"));
+			parseStack.push_back(table->getSymbolId(table->getStartSymbol()));
+			recordStackPeak(parseStack);
 
 			size_t i = 0;
 			tokens.push_back("$");
 
-			const std::map<std::string, std::map<std::string, std::vector<std::string> > >& parseTable = table.getParseTable();
+			//! EVERY TOKEN IS CLASSIFIED ONCE, UP FRONT, SO UNKNOWN INPUT IS REJECTED BEFORE ANY PARSING
+			std::vector<size_t> unknownPositions;
+			std::vector<int> tokenIds = classifier.classify(tokens, unknownPositions);
+			if (!unknownPositions.empty()) {
+				for (size_t k = 0; k < unknownPositions.size(); ++k) {
+					report("Error: unknown token \"" + tokens[unknownPositions[k]] + "\" at position " + std::to_string(unknownPositions[k]));
+				}
+				return false;
+			}
 
 			while (!parseStack.empty()) {
-				std::string top = parseStack.top();
-				std::string currentToken = tokens.at(i);
-				parseStack.pop();
+				int top = parseStack.back();
+				int currentToken = tokenIds.at(i);
+				parseStack.pop_back();
 
-				if (top == currentToken) {
+				if (table->isTerminalId(top)) {
+					if (top != currentToken) {
+						report("Error: unexpected token \"" + tokens[i] + "\" at position " + std::to_string(i) + ", expected \"" + table->getSymbol(top) + "\"");
+						return false;
+					}
 					i++;
 				}
-				else if (table.isTerminal(top)) {
-					std::cerr << "Error: unexpected token \"" << currentToken << "\" at position " << i << ", expected \"" << top << "\"\n";
-					return false;
-				}
 				else {
-					std::map<std::string, std::map<std::string, std::vector<std::string> > >::const_iterator row = parseTable.find(top);
-					if (row == parseTable.end()) {
-						std::cerr << "Error: No entry for non-terminal '" << top << "' in the parse table.\n";
+					const PredictiveTable::ParseRow* row = table->getParseRow(top);
+					if (row == nullptr) {
+						report("Error: No entry for non-terminal '" + table->getSymbol(top) + "' in the parse table.");
 						return false;
 					}
 
-					std::map<std::string, std::vector<std::string>>::const_iterator it = row->second.find(currentToken);
-					if (it == row->second.end()) {
-						std::cerr << "Error: no rule for (" << top << ", " << currentToken << ")\n";
+					int alternative = row->entries[currentToken];
+					if (alternative == PredictiveTable::ParseRow::NO_ENTRY) {
+						report("Error: no rule for (" + table->getSymbol(top) + ", " + tokens[i] + ")");
 						return false;
 					}
 
-					const std::vector<std::string>& production = it->second;
-					for (int j = static_cast<int>(production.size()) - 1; j >= 0; --j) {
-						if (production[j] != "~") {
-							parseStack.push(production[j]);
-						}
+					for (size_t j = row->starts[alternative + 1]; j > row->starts[alternative]; --j) {
+						parseStack.push_back(row->symbols[j - 1]);
 					}
+					recordStackPeak(parseStack);
 				}
 			}
 
 			return i == tokens.size();
 		}
 
-	private:
-		std::map<std::string, std::vector<std::string> >::iterator getRule(const std::string& lhs, const std::string& input) {
-			return table.getParseTable().at(lhs).find(input);
+		void recordStackPeak(const std::vector<int>& parseStack) {
+			MemoryUsage usage(0, sizeof(parseStack) + parseStack.capacity() * sizeof(int));
+
+			if (parseStack.size() > peakStackDepth) {
+				peakStackDepth = parseStack.size();
+			}
+			if (usage.total() > peakStackUsage.total()) {
+				peakStackUsage = usage;
+			}
 		}
 
-		std::map<std::string, std::vector<std::string> >::iterator getEnd(const std::string& nonTerminal) {
-			return table.getParseTable().at(nonTerminal).end();
+		void report(const std::string& message) {
+			diagnostics.push_back(message);
+			std::cerr << message << "\n";
 		}
 };
 
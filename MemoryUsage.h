@@ -0,0 +1,104 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+
+namespace utils {
+	//! PAYLOAD IS THE RAW SYMBOL TEXT, OVERHEAD IS EVERYTHING THE CONTAINERS ADD AROUND IT
+	struct MemoryUsage {
+		size_t payloadBytes;
+		size_t overheadBytes;
+
+		MemoryUsage() : payloadBytes(0), overheadBytes(0) {}
+
+		MemoryUsage(const size_t payload, const size_t overhead) : payloadBytes(payload), overheadBytes(overhead) {}
+
+		size_t total() const {
+			return payloadBytes + overheadBytes;
+		}
+
+		MemoryUsage& operator+=(const MemoryUsage& other) {
+			payloadBytes += other.payloadBytes;
+			overheadBytes += other.overheadBytes;
+			return *this;
+		}
+
+		MemoryUsage& operator-=(const MemoryUsage& other) {
+			payloadBytes -= other.payloadBytes;
+			overheadBytes -= other.overheadBytes;
+			return *this;
+		}
+	};
+
+	//! ESTIMATES ONLY: THE ALLOCATOR'S OWN HEADERS AND ALIGNMENT PADDING ARE NOT VISIBLE FROM HERE
+	class MemoryUtils {
+		public:
+			//! COLOR + PARENT/LEFT/RIGHT LINKS OF A RED-BLACK TREE NODE
+			static const size_t TREE_NODE_OVERHEAD = 4 * sizeof(void*);
+
+			static MemoryUsage usageOf(const std::string& str) {
+				const char* data = str.data();
+				const char* self = reinterpret_cast<const char*>(&str);
+				const bool isInline = data >= self && data < self + sizeof(std::string);
+
+				size_t footprint = sizeof(std::string);
+				if (!isInline) {
+					footprint += str.capacity() + 1;
+				}
+				return MemoryUsage(str.size(), footprint - str.size());
+			}
+
+			static MemoryUsage usageOf(const size_t) {
+				return MemoryUsage(0, sizeof(size_t));
+			}
+
+			static MemoryUsage sum(const std::map<std::string, MemoryUsage>& components) {
+				MemoryUsage usage;
+				for (std::map<std::string, MemoryUsage>::const_iterator it = components.begin(); it != components.end(); ++it) {
+					usage += it->second;
+				}
+				return usage;
+			}
+
+			template <typename T>
+			static MemoryUsage usageOf(const std::vector<T>& vec) {
+				MemoryUsage usage(0, sizeof(std::vector<T>) + (vec.capacity() - vec.size()) * sizeof(T));
+				for (size_t i = 0; i < vec.size(); ++i) {
+					usage += usageOf(vec[i]);
+				}
+				return usage;
+			}
+
+			template <typename F, typename S>
+			static MemoryUsage usageOf(const std::pair<F, S>& pair) {
+				MemoryUsage usage = usageOf(pair.first);
+				usage += usageOf(pair.second);
+				return usage;
+			}
+
+			template <typename T>
+			static MemoryUsage usageOf(const std::set<T>& set) {
+				MemoryUsage usage(0, sizeof(std::set<T>) + set.size() * TREE_NODE_OVERHEAD);
+				for (typename std::set<T>::const_iterator it = set.begin(); it != set.end(); ++it) {
+					usage += usageOf(*it);
+				}
+				return usage;
+			}
+
+			template <typename K, typename V, typename C, typename A>
+			static MemoryUsage usageOf(const std::map<K, V, C, A>& map) {
+				MemoryUsage usage(0, sizeof(std::map<K, V, C, A>) + map.size() * TREE_NODE_OVERHEAD);
+				for (typename std::map<K, V, C, A>::const_iterator it = map.begin(); it != map.end(); ++it) {
+					usage += usageOf(it->first);
+					usage += usageOf(it->second);
+				}
+				return usage;
+			}
+	};
+};
+
+#endif //MEMORY_USAGE_H
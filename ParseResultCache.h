@@ -0,0 +1,170 @@
+#ifndef PARSE_RESULT_CACHE_H
+#define PARSE_RESULT_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <iostream>
+
+#include "HashUtils.h"
+#include "MemoryUsage.h"
+
+using namespace utils;
+
+struct ParseResult {
+	bool accepted;
+
+	std::vector<std::string> diagnostics;
+
+	ParseResult() : accepted(false) {}
+};
+
+//! REMEMBERS THE VERDICT AND DIAGNOSTICS OF A PARSE, KEYED BY THE TOKEN STREAM AND THE GRAMMAR IDENTITY.
+//! ONE INSTANCE CAN BE SHARED BY ANY NUMBER OF PARSERS AND THREADS, LEAST RECENTLY USED ENTRIES
+//! ARE EVICTED ONCE THE ESTIMATED SIZE OF THE STORED RESULTS EXCEEDS THE BUDGET.
+class ParseResultCache {
+	public:
+		struct Key {
+			Hash128 tokens;
+
+			uint64_t grammar;
+
+			Key() : grammar(0) {}
+
+			bool operator<(const Key& other) const {
+				return grammar < other.grammar || (grammar == other.grammar && tokens < other.tokens);
+			}
+		};
+
+	private:
+		struct Entry {
+			Key key;
+
+			std::shared_ptr<const ParseResult> result;
+
+			size_t bytes;
+		};
+
+		mutable std::mutex lock;
+
+		//! MOST RECENTLY USED FIRST
+		std::list<Entry> entries;
+
+		std::map<Key, std::list<Entry>::iterator> index;
+
+		size_t budgetBytes;
+
+		size_t usedBytes;
+
+		size_t hits;
+
+		size_t misses;
+
+		size_t evictions;
+
+	public:
+		explicit ParseResultCache(const size_t budgetBytesInput)
+		: budgetBytes(budgetBytesInput), usedBytes(0), hits(0), misses(0), evictions(0) {}
+
+		static Key makeKey(const std::vector<std::string>& tokens, const uint64_t grammarIdentity) {
+			Key key;
+			key.tokens = HashUtils::hash128(tokens, grammarIdentity);
+			key.grammar = grammarIdentity;
+			return key;
+		}
+
+		//! RETURNS nullptr ON A MISS
+		std::shared_ptr<const ParseResult> lookup(const Key& key) {
+			std::lock_guard<std::mutex> guard(lock);
+
+			std::map<Key, std::list<Entry>::iterator>::iterator it = index.find(key);
+			if (it == index.end()) {
+				misses++;
+				return std::shared_ptr<const ParseResult>();
+			}
+
+			hits++;
+			entries.splice(entries.begin(), entries, it->second);
+			return it->second->result;
+		}
+
+		void store(const Key& key, const ParseResult& result) {
+			Entry entry;
+			entry.key = key;
+			entry.result = std::make_shared<ParseResult>(result);
+			entry.bytes = sizeof(Entry) + sizeof(ParseResult) + 2 * MemoryUtils::TREE_NODE_OVERHEAD + MemoryUtils::usageOf(result.diagnostics).total();
+
+			std::lock_guard<std::mutex> guard(lock);
+
+			if (entry.bytes > budgetBytes || index.find(key) != index.end()) {
+				return;
+			}
+
+			while (usedBytes + entry.bytes > budgetBytes) {
+				evictLeastRecentlyUsed();
+			}
+
+			entries.push_front(entry);
+			index[key] = entries.begin();
+			usedBytes += entry.bytes;
+		}
+
+		void clear() {
+			std::lock_guard<std::mutex> guard(lock);
+			entries.clear();
+			index.clear();
+			usedBytes = 0;
+		}
+
+		size_t getHits() const {
+			std::lock_guard<std::mutex> guard(lock);
+			return hits;
+		}
+
+		size_t getMisses() const {
+			std::lock_guard<std::mutex> guard(lock);
+			return misses;
+		}
+
+		size_t getEvictions() const {
+			std::lock_guard<std::mutex> guard(lock);
+			return evictions;
+		}
+
+		size_t getSize() const {
+			std::lock_guard<std::mutex> guard(lock);
+			return entries.size();
+		}
+
+		MemoryUsage getMemoryUsage() const {
+			std::lock_guard<std::mutex> guard(lock);
+			return MemoryUsage(0, sizeof(ParseResultCache) + usedBytes);
+		}
+
+		void printStatistics() const {
+			std::lock_guard<std::mutex> guard(lock);
+
+			std::cout << "\n=== Parse Result Cache ===\n";
+			std::cout << "Entries:   " << entries.size() << "\n";
+			std::cout << "Bytes:     " << usedBytes << " / " << budgetBytes << "\n";
+			std::cout << "Hits:      " << hits << "\n";
+			std::cout << "Misses:    " << misses << "\n";
+			std::cout << "Evictions: " << evictions << "\n";
+		}
+
+	private:
+		//! MUST BE CALLED WITH lock HELD
+		void evictLeastRecentlyUsed() {
+			const Entry& victim = entries.back();
+			usedBytes -= victim.bytes;
+			index.erase(victim.key);
+			entries.pop_back();
+			evictions++;
+		}
+};
+
+#endif //PARSE_RESULT_CACHE_H
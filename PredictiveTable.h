@@ -12,23 +12,120 @@
 #include <string>
 #include <iostream>
 #include <iomanip>
+#include <memory>
+#include <mutex>
+#include <atomic>
 
 
 #include "Grammar.h"
+#include "TerminalClassifier.h"
+#include "ArenaAllocator.h"
 
 class PredictiveTable {
+    public:
+        //! ONE ROW OVER SYMBOL IDS, SEE getSymbolId(). THE PARSER INDEXES entries WITH THE ID OF THE CURRENT
+        //! TOKEN AND PUSHES THE PREDICTED symbols, SO A STEP NEVER HASHES OR COMPARES A STRING.
+        //! EVERY VECTOR OF A ROW COMES FROM THE TABLE'S MemoryResource.
+        struct ParseRow {
+            enum { NO_ENTRY = -1 };
+
+            //! TERMINAL ID -> PREDICTED ALTERNATIVE, NO_ENTRY WHERE THE TABLE IS EMPTY
+            std::vector<int, ArenaAllocator<int>> entries;
+
+            //! ALTERNATIVE a IS symbols[starts[a], starts[a + 1]), WITHOUT ITS "~"
+            std::vector<size_t, ArenaAllocator<size_t>> starts;
+
+            std::vector<int, ArenaAllocator<int>> symbols;
+
+            explicit ParseRow(MemoryResource* resource)
+            : entries(ArenaAllocator<int>(resource)), starts(ArenaAllocator<size_t>(resource)), symbols(ArenaAllocator<int>(resource)) {}
+
+            MemoryUsage getMemoryUsage() const {
+                return MemoryUsage(0, sizeof(ParseRow) + entries.capacity() * sizeof(int) + starts.capacity() * sizeof(size_t) + symbols.capacity() * sizeof(int));
+            }
+        };
+
     private:
+        //! DESTROYS A ROW AND HANDS ITS MEMORY BACK TO THE RESOURCE IT CAME FROM
+        struct RowDeleter {
+            MemoryResource* resource;
+
+            explicit RowDeleter(MemoryResource* resourceInput) : resource(resourceInput) {}
+
+            void operator()(ParseRow* row) const {
+                row->~ParseRow();
+                ArenaAllocator<ParseRow>(resource).deallocate(row, 1);
+            }
+        };
+
+        //! ROWS HANDED OUT BY getParseRow(), SHARED BY EVERY COPY OF THE TABLE.
+        //! A ROW IS BUILT ONCE UNDER lock AND THEN PUBLISHED, READERS ONLY DO AN ATOMIC LOAD.
+        struct RowCache {
+            std::mutex lock;
+
+            std::map<std::string, size_t> index;
+
+            //! SLOT -> NON-TERMINAL, THE INVERSE OF index
+            std::vector<std::string> names;
+
+            std::unique_ptr<std::atomic<const ParseRow*>[]> rows;
+
+            std::map<std::string, std::set<std::string>> firstMem;
+
+            //! ONLY FINISHED FOLLOW SETS, FILLED IN BY followOf() AS ROWS NEED THEM
+            std::map<std::string, std::set<std::string>> followSet;
+
+            //! NON-TERMINAL -> EVERY (LHS, SUFFIX AFTER IT) WHERE IT APPEARS ON A RIGHT-HAND SIDE
+            std::map<std::string, std::vector<std::pair<std::string, std::vector<std::string>>>> occurrences;
+
+            bool occurrencesIndexed;
+
+            MemoryResource* resource;
+
+            RowCache(const std::map<std::string, std::vector<std::vector<std::string>>>& productions, MemoryResource* resourceInput)
+            : rows(new std::atomic<const ParseRow*>[productions.size()]), occurrencesIndexed(false), resource(resourceInput) {
+                std::map<std::string, std::vector<std::vector<std::string>>>::const_iterator it;
+                for (it = productions.begin(); it != productions.end(); ++it) {
+                    rows[index.size()].store(nullptr, std::memory_order_relaxed);
+                    index.insert(std::make_pair(it->first, index.size()));
+                    names.push_back(it->first);
+                }
+            }
+
+            ~RowCache() {
+                RowDeleter deleter(resource);
+                for (size_t i = 0; i < index.size(); ++i) {
+                    const ParseRow* row = rows[i].load(std::memory_order_relaxed);
+                    if (row != nullptr) {
+                        deleter(const_cast<ParseRow*>(row));
+                    }
+                }
+            }
+        };
+
         Grammar grammar;
 
+        TerminalClassifier classifier;
+
         std::map<std::string, std::set<std::string>> firstSet;
 
         std::map<std::string, std::set<std::string>> followSet;
 
         std::map<std::string, std::map<std::string, std::vector<std::string>>> parseTable;
 
+        bool lazy;
+
+        std::shared_ptr<RowCache> rowCache;
+
     public:
 
-        explicit PredictiveTable(Grammar grammar) : grammar(grammar) {
+        //! A LAZY TABLE BUILDS EACH ROW THE FIRST TIME getParseRow() ASKS FOR IT. IT COMPUTES FOLLOW ONLY FOR A
+        //! ROW WITH A NULLABLE PRODUCTION, AND ONLY OVER THE NON-TERMINALS THAT FOLLOW SET DEPENDS ON.
+        //! OTHERWISE THE FIRST LOOKUP BUILDS EVERY ROW.
+        //! rowResource PLACES THE ROWS IN A CALLER-PROVIDED ARENA, nullptr MEANS THE HEAP.
+        explicit PredictiveTable(Grammar grammar, const bool lazyInput = false, MemoryResource* rowResource = nullptr)
+        : grammar(grammar), classifier(grammar.getTerminals()), lazy(lazyInput),
+          rowCache(std::make_shared<RowCache>(grammar.getProductions(), rowResource ? rowResource : &HeapResource::getInstance())) {
         }
 
         bool isTerminal(const std::string& symbol) const {
@@ -43,6 +140,14 @@ class PredictiveTable {
             return grammar.getStartSymbol();
         }
 
+        uint64_t getGrammarIdentity() const {
+            return grammar.getIdentity();
+        }
+
+        const TerminalClassifier& getClassifier() const {
+            return classifier;
+        }
+
         std::map<std::string, std::set<std::string>> getFirstSet() {
             if (firstSet.empty()) {
                 computeFirstSet();
@@ -64,6 +169,108 @@ class PredictiveTable {
             return parseTable;
         }
 
+        //! TERMINALS KEEP THEIR CLASSIFIER ID, THE NON-TERMINAL IN ROW SLOT n IS classifier.size() + n.
+        //! A NAME THAT IS BOTH A TERMINAL AND A NON-TERMINAL IS THE TERMINAL, AS IN FIRST(). UNKNOWN FOR ANYTHING ELSE.
+        int getSymbolId(const std::string& symbol) const {
+            int id = classifier.classify(symbol);
+            if (id != TerminalClassifier::UNKNOWN) {
+                return id;
+            }
+
+            std::map<std::string, size_t>::const_iterator slot = rowCache->index.find(symbol);
+            return slot != rowCache->index.end() ? static_cast<int>(classifier.size() + slot->second) : static_cast<int>(TerminalClassifier::UNKNOWN);
+        }
+
+        bool isTerminalId(const int id) const {
+            return id >= 0 && static_cast<size_t>(id) < classifier.size();
+        }
+
+        //! FOR DIAGNOSTICS, EMPTY FOR AN UNKNOWN ID
+        std::string getSymbol(const int id) const {
+            if (isTerminalId(id)) {
+                return classifier.getLexeme(id);
+            }
+            if (id >= 0 && static_cast<size_t>(id) - classifier.size() < rowCache->names.size()) {
+                return rowCache->names[id - classifier.size()];
+            }
+            return std::string();
+        }
+
+        //! SAFE TO CALL FROM SEVERAL THREADS, RETURNS nullptr FOR AN ID THAT IS NOT A NON-TERMINAL WITH PRODUCTIONS
+        const ParseRow* getParseRow(const int symbolId) const {
+            if (symbolId < 0 || static_cast<size_t>(symbolId) < classifier.size() || static_cast<size_t>(symbolId) - classifier.size() >= rowCache->names.size()) {
+                return nullptr;
+            }
+            const size_t slot = symbolId - classifier.size();
+
+            const ParseRow* row = rowCache->rows[slot].load(std::memory_order_acquire);
+            if (row != nullptr) {
+                return row;
+            }
+
+            std::lock_guard<std::mutex> guard(rowCache->lock);
+            if (lazy) {
+                publishRow(slot);
+            } else {
+                for (size_t i = 0; i < rowCache->names.size(); ++i) {
+                    publishRow(i);
+                }
+            }
+            return rowCache->rows[slot].load(std::memory_order_relaxed);
+        }
+
+        const ParseRow* getParseRow(const std::string& nonTerminal) const {
+            std::map<std::string, size_t>::const_iterator slot = rowCache->index.find(nonTerminal);
+            if (slot == rowCache->index.end()) {
+                return nullptr;
+            }
+            return getParseRow(static_cast<int>(classifier.size() + slot->second));
+        }
+
+        std::map<std::string, MemoryUsage> getMemoryUsageByComponent() const {
+            std::map<std::string, MemoryUsage> components;
+            components["grammar"] = grammar.getMemoryUsage();
+            components["classifier"] = classifier.getMemoryUsage();
+            components["firstSet"] = MemoryUtils::usageOf(firstSet);
+            components["followSet"] = MemoryUtils::usageOf(followSet);
+            components["parseTable"] = MemoryUtils::usageOf(parseTable);
+            components["parseRows"] = getRowCacheMemoryUsage();
+            return components;
+        }
+
+        MemoryUsage getMemoryUsage() const {
+            return MemoryUtils::sum(getMemoryUsageByComponent());
+        }
+
+        void printMemoryUsage() const {
+            printMemoryUsage(getMemoryUsageByComponent());
+        }
+
+        static void printMemoryUsage(const std::map<std::string, MemoryUsage>& components) {
+            std::cout << "\n=== Memory Usage (bytes) ===\n";
+
+            std::cout << std::left << std::setw(15) << "Component"
+                      << std::setw(15) << "Payload"
+                      << std::setw(15) << "Overhead"
+                      << "Total\n";
+            std::cout << "--------------------------------------------------------\n";
+
+            std::map<std::string, MemoryUsage>::const_iterator it;
+            for (it = components.begin(); it != components.end(); ++it) {
+                std::cout << std::left << std::setw(15) << it->first
+                          << std::setw(15) << it->second.payloadBytes
+                          << std::setw(15) << it->second.overheadBytes
+                          << it->second.total() << "\n";
+            }
+
+            MemoryUsage total = MemoryUtils::sum(components);
+
+            std::cout << std::left << std::setw(15) << "total"
+                      << std::setw(15) << total.payloadBytes
+                      << std::setw(15) << total.overheadBytes
+                      << total.total() << "\n";
+        }
+
         void printFirstSet() {
             if (firstSet.empty()) {
                 computeFirstSet();
@@ -176,7 +383,10 @@ class PredictiveTable {
 			}
 
 			std::map<std::string, std::set<std::string>> mem;
+			computeFollowSet(followSet, mem);
+		}
 
+		void computeFollowSet(std::map<std::string, std::set<std::string>>& followSet, std::map<std::string, std::set<std::string>>& mem) const {
 			std::map<std::string, std::vector<std::vector<std::string>>> productions = grammar.getProductions();
     
 			std::map<std::string, std::vector<std::vector<std::string>>>::iterator it;
@@ -187,7 +397,7 @@ class PredictiveTable {
 				}
 			}
 
-			const std::string& startSymbol = productions.begin()->first;
+			const std::string startSymbol = grammar.getStartSymbol();
 			followSet[startSymbol].insert("$");
 
 			bool changed = true;
@@ -196,7 +406,7 @@ class PredictiveTable {
 
 				for (it = productions.begin(); it != productions.end(); ++it) {
 					for (size_t i = 0; i < it->second.size(); ++i) {
-						if (FOLLOW(it->first, it->second[i], mem)) {
+						if (FOLLOW(it->first, it->second[i], mem, followSet)) {
 							changed = true;
 						}
 					}
@@ -206,7 +416,7 @@ class PredictiveTable {
 
 
 
-        bool FOLLOW(const std::string& lhs, const std::vector<std::string>& rhs, std::map<std::string, std::set<std::string>>& mem) {
+        bool FOLLOW(const std::string& lhs, const std::vector<std::string>& rhs, std::map<std::string, std::set<std::string>>& mem, std::map<std::string, std::set<std::string>>& followSet) const {
             bool changed = false;
 
             for (size_t i = 0; i < rhs.size(); ++i) {
@@ -247,24 +457,197 @@ class PredictiveTable {
             std::map<std::string, std::vector<std::vector<std::string>>>::iterator it;
 
             for (it = productions.begin(); it != productions.end(); ++it) {
-                for (size_t i = 0; i < it->second.size(); ++i) {
-                    std::set<std::string> first = FIRST(it->second[i], mem);
+                std::map<std::string, std::vector<std::string>>& row = parseTable[it->first];
+                std::map<std::string, size_t> predicted = predict(it->first, mem, followSet);
+
+                std::map<std::string, size_t>::const_iterator pit;
+                for (pit = predicted.begin(); pit != predicted.end(); ++pit) {
+                    row[pit->first] = it->second[pit->second];
+                }
+            }
+        }
+
+        //! TERMINAL -> INDEX OF THE ALTERNATIVE OF lhs PREDICTED FOR IT, ON A CONFLICT THE LATER ALTERNATIVE WINS
+        std::map<std::string, size_t> predict(const std::string& lhs, std::map<std::string, std::set<std::string>>& mem, const std::map<std::string, std::set<std::string>>& followSet) const {
+            std::map<std::string, size_t> row;
+            std::vector<std::vector<std::string>> productions = grammar.getProduction(lhs);
+
+            for (size_t i = 0; i < productions.size(); ++i) {
+                std::set<std::string> first = FIRST(productions[i], mem);
+
+                std::set<std::string>::iterator fit;
+                for (fit = first.begin(); fit != first.end(); ++fit) {
+                    if (*fit != "~") {
+                        row[*fit] = i;
+                    }
+                }
+
+                if (first.find("~") != first.end()) {
+                    std::map<std::string, std::set<std::string>>::const_iterator follow = followSet.find(lhs);
+                    if (follow == followSet.end()) continue;
+
+                    std::set<std::string>::const_iterator fset;
+                    for (fset = follow->second.begin(); fset != follow->second.end(); ++fset) {
+                        row[*fset] = i;
+                    }
+                }
+            }
+            return row;
+        }
+
+        //! MUST BE CALLED WITH rowCache->lock HELD
+        void publishRow(const size_t slot) const {
+            if (rowCache->rows[slot].load(std::memory_order_relaxed) != nullptr) {
+                return;
+            }
+
+            const std::string& lhs = rowCache->names[slot];
+            if (isNullable(lhs, rowCache->firstMem)) {
+                followOf(lhs);
+            }
+
+            //! predict() THROWS FOR A SYMBOL WITHOUT PRODUCTIONS, SO IT RUNS BEFORE THE ROW IS ALLOCATED.
+            //! THE GUARD GIVES THE ROW BACK TO THE RESOURCE IF FILLING IT FAILS ANYWAY.
+            std::map<std::string, size_t> predicted = predict(lhs, rowCache->firstMem, rowCache->followSet);
+            std::vector<std::vector<std::string>> productions = grammar.getProduction(lhs);
+
+            ArenaAllocator<ParseRow> allocator(rowCache->resource);
+            std::unique_ptr<ParseRow, RowDeleter> row(new (allocator.allocate(1)) ParseRow(rowCache->resource), RowDeleter(rowCache->resource));
+
+            row->entries.assign(classifier.size(), ParseRow::NO_ENTRY);
+            for (size_t i = 0; i < productions.size(); ++i) {
+                row->starts.push_back(row->symbols.size());
+                for (size_t j = 0; j < productions[i].size(); ++j) {
+                    if (productions[i][j] != "~") {
+                        row->symbols.push_back(getSymbolId(productions[i][j]));
+                    }
+                }
+            }
+            row->starts.push_back(row->symbols.size());
+
+            std::map<std::string, size_t>::const_iterator it;
+            for (it = predicted.begin(); it != predicted.end(); ++it) {
+                int terminal = classifier.classify(it->first);
+                if (terminal != TerminalClassifier::UNKNOWN) {
+                    row->entries[terminal] = static_cast<int>(it->second);
+                }
+            }
+
+            rowCache->rows[slot].store(row.release(), std::memory_order_release);
+        }
+
+        //! MUST BE CALLED WITH rowCache->lock HELD. FOLLOW(A) ONLY DEPENDS ON FIRST OF WHAT COMES AFTER A AND ON
+        //! FOLLOW OF EVERY LHS WHERE A CAN END THE RULE, SO THE FIXPOINT RUNS OVER THAT CLOSURE INSTEAD OF THE GRAMMAR.
+        void followOf(const std::string& symbol) const {
+            RowCache& cache = *rowCache;
+            if (cache.followSet.find(symbol) != cache.followSet.end()) {
+                return;
+            }
+
+            if (!cache.occurrencesIndexed) {
+                indexOccurrences();
+            }
+
+            const std::string startSymbol = grammar.getStartSymbol();
+            std::map<std::string, std::set<std::string>> partial;
+            std::map<std::string, std::set<std::string>> dependsOn;
+
+            std::vector<std::string> pending(1, symbol);
+            while (!pending.empty()) {
+                std::string current = pending.back();
+                pending.pop_back();
+                if (partial.find(current) != partial.end() || cache.followSet.find(current) != cache.followSet.end()) {
+                    continue;
+                }
+
+                std::set<std::string>& follow = partial[current];
+                if (current == startSymbol) {
+                    follow.insert("$");
+                }
+
+                const std::vector<std::pair<std::string, std::vector<std::string>>>& uses = cache.occurrences[current];
+                for (size_t i = 0; i < uses.size(); ++i) {
+                    std::set<std::string> firstOfBeta = FIRST(uses[i].second, cache.firstMem);
+                    bool hasEpsilon = uses[i].second.empty() || firstOfBeta.find("~") != firstOfBeta.end();
+                    firstOfBeta.erase("~");
+                    follow.insert(firstOfBeta.begin(), firstOfBeta.end());
+
+                    if (hasEpsilon && uses[i].first != current) {
+                        dependsOn[current].insert(uses[i].first);
+                        pending.push_back(uses[i].first);
+                    }
+                }
+            }
 
-                    std::set<std::string>::iterator fit;
-                    for (fit = first.begin(); fit != first.end(); ++fit) {
-                        if (*fit != "~") {
-                            parseTable[it->first][*fit] = it->second[i];
+            bool changed = true;
+            while (changed) {
+                changed = false;
+
+                std::map<std::string, std::set<std::string>>::iterator it;
+                for (it = partial.begin(); it != partial.end(); ++it) {
+                    const std::set<std::string>& sources = dependsOn[it->first];
+                    std::set<std::string>::const_iterator source;
+                    for (source = sources.begin(); source != sources.end(); ++source) {
+                        std::map<std::string, std::set<std::string>>::const_iterator done = cache.followSet.find(*source);
+                        const std::set<std::string>& from = (done != cache.followSet.end()) ? done->second : partial[*source];
+
+                        size_t before = it->second.size();
+                        it->second.insert(from.begin(), from.end());
+                        if (it->second.size() > before) {
+                            changed = true;
                         }
                     }
+                }
+            }
+
+            cache.followSet.insert(partial.begin(), partial.end());
+        }
 
-                    if (first.find("~") != first.end()) {
-                        std::set<std::string>::iterator fset;
-                        for (fset = followSet[it->first].begin(); fset != followSet[it->first].end(); ++fset) {
-                            parseTable[it->first][*fset] = it->second[i];
+        void indexOccurrences() const {
+            std::map<std::string, std::vector<std::vector<std::string>>> productions = grammar.getProductions();
+            std::map<std::string, std::vector<std::vector<std::string>>>::const_iterator it;
+            for (it = productions.begin(); it != productions.end(); ++it) {
+                for (size_t i = 0; i < it->second.size(); ++i) {
+                    const std::vector<std::string>& rhs = it->second[i];
+                    for (size_t j = 0; j < rhs.size(); ++j) {
+                        if (grammar.isNonTerminal(rhs[j])) {
+                            rowCache->occurrences[rhs[j]].push_back(std::make_pair(it->first, std::vector<std::string>(rhs.begin() + j + 1, rhs.end())));
                         }
                     }
                 }
             }
+            rowCache->occurrencesIndexed = true;
+        }
+
+        bool isNullable(const std::string& lhs, std::map<std::string, std::set<std::string>>& mem) const {
+            std::vector<std::vector<std::string>> productions = grammar.getProduction(lhs);
+            for (size_t i = 0; i < productions.size(); ++i) {
+                std::set<std::string> first = FIRST(productions[i], mem);
+                if (first.find("~") != first.end()) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        MemoryUsage getRowCacheMemoryUsage() const {
+            std::lock_guard<std::mutex> guard(rowCache->lock);
+
+            MemoryUsage usage(0, sizeof(RowCache) + rowCache->index.size() * sizeof(std::atomic<const ParseRow*>));
+            usage += MemoryUtils::usageOf(rowCache->index);
+            usage += MemoryUtils::usageOf(rowCache->names);
+            usage += MemoryUtils::usageOf(rowCache->firstMem);
+            usage += MemoryUtils::usageOf(rowCache->followSet);
+            usage += MemoryUtils::usageOf(rowCache->occurrences);
+
+            std::map<std::string, size_t>::const_iterator it;
+            for (it = rowCache->index.begin(); it != rowCache->index.end(); ++it) {
+                const ParseRow* row = rowCache->rows[it->second].load(std::memory_order_relaxed);
+                if (row != nullptr) {
+                    usage += row->getMemoryUsage();
+                }
+            }
+            return usage;
         }
 
 };
@@ -6,7 +6,7 @@
 namespace utils {
 	class StringUtils {
 		public:
-			std::string trim(const std::string& str) {
+			static std::string trim(const std::string& str) {
 				auto start = str.find_first_not_of(" \t\n\r\f\v");
 				if (start == std::string::npos)
 					return "";
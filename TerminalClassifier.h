@@ -0,0 +1,166 @@
+#ifndef TERMINAL_CLASSIFIER_H
+#define TERMINAL_CLASSIFIER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <set>
+#include <bitset>
+#include <algorithm>
+
+#include "HashUtils.h"
+#include "MemoryUsage.h"
+
+using namespace utils;
+
+//! MAPS TOKEN LEXEMES TO TERMINAL IDS THROUGH A MINIMAL PERFECT HASH (HASH AND DISPLACE).
+//! EVERY LEXEME HASHES TO A BUCKET, EVERY BUCKET STORES THE SEED THAT SPREADS ITS LEXEMES
+//! OVER FREE SLOTS, SO A LOOKUP IS ONE HASH AND ONE STRING COMPARE WHATEVER THE TERMINAL COUNT.
+class TerminalClassifier {
+	public:
+		enum { UNKNOWN = -1 };
+
+	private:
+		std::vector<std::string> lexemes;
+
+		std::vector<uint32_t> seeds;
+
+		std::vector<int> slots;
+
+		size_t minLength;
+
+		size_t maxLength;
+
+		std::bitset<256> firstBytes;
+
+	public:
+		TerminalClassifier() : minLength(0), maxLength(0) {}
+
+		//! "$" IS ALWAYS CLASSIFIED SO THE END MARKER APPENDED BY THE PARSER HAS AN ID TOO
+		explicit TerminalClassifier(const std::set<std::string>& terminals) : minLength(0), maxLength(0) {
+			std::set<std::string> keys(terminals);
+			keys.insert("$");
+			lexemes.assign(keys.begin(), keys.end());
+			build();
+		}
+
+		int classify(const std::string& token) const {
+			if (lexemes.empty() || token.length() < minLength || token.length() > maxLength) {
+				return UNKNOWN;
+			}
+			if (!token.empty() && !firstBytes.test(static_cast<unsigned char>(token[0]))) {
+				return UNKNOWN;
+			}
+
+			uint64_t hash = HashUtils::fnv1a(token);
+			uint32_t seed = seeds[HashUtils::mix(hash) % seeds.size()];
+			int id = slots[slotHash(hash, seed) % slots.size()];
+			return lexemes[id] == token ? id : UNKNOWN;
+		}
+
+		//! CLASSIFIES A WHOLE INPUT IN ONE PASS, RECORDING WHERE THE UNKNOWN TOKENS ARE
+		std::vector<int> classify(const std::vector<std::string>& tokens, std::vector<size_t>& unknownPositions) const {
+			std::vector<int> ids(tokens.size());
+			for (size_t i = 0; i < tokens.size(); i++) {
+				ids[i] = classify(tokens[i]);
+			}
+			for (size_t i = 0; i < ids.size(); i++) {
+				if (ids[i] == UNKNOWN) {
+					unknownPositions.push_back(i);
+				}
+			}
+			return ids;
+		}
+
+		const std::string& getLexeme(const int id) const {
+			return lexemes.at(id);
+		}
+
+		size_t size() const {
+			return lexemes.size();
+		}
+
+		MemoryUsage getMemoryUsage() const {
+			MemoryUsage usage = MemoryUtils::usageOf(lexemes);
+			usage += MemoryUsage(0, sizeof(std::vector<uint32_t>) + seeds.capacity() * sizeof(uint32_t));
+			usage += MemoryUsage(0, sizeof(std::vector<int>) + slots.capacity() * sizeof(int));
+			usage += MemoryUsage(0, sizeof(minLength) + sizeof(maxLength) + sizeof(firstBytes));
+			return usage;
+		}
+
+	private:
+		static uint64_t slotHash(const uint64_t hash, const uint32_t seed) {
+			return HashUtils::mix(hash ^ (static_cast<uint64_t>(seed) * 0x9e3779b97f4a7c15ULL));
+		}
+
+		void build() {
+			minLength = lexemes.front().length();
+			maxLength = minLength;
+			for (size_t i = 0; i < lexemes.size(); i++) {
+				minLength = std::min(minLength, lexemes[i].length());
+				maxLength = std::max(maxLength, lexemes[i].length());
+				if (!lexemes[i].empty()) {
+					firstBytes.set(static_cast<unsigned char>(lexemes[i][0]));
+				}
+			}
+
+			//! AROUND FOUR LEXEMES PER BUCKET KEEPS THE SEED TABLE SMALL AND THE SEARCH SHORT
+			std::vector<uint64_t> hashes(lexemes.size());
+			std::vector<std::vector<int>> buckets(lexemes.size() / 4 + 1);
+			for (size_t i = 0; i < lexemes.size(); i++) {
+				hashes[i] = HashUtils::fnv1a(lexemes[i]);
+				buckets[HashUtils::mix(hashes[i]) % buckets.size()].push_back(static_cast<int>(i));
+			}
+
+			std::vector<size_t> order(buckets.size());
+			for (size_t i = 0; i < order.size(); i++) {
+				order[i] = i;
+			}
+			std::stable_sort(order.begin(), order.end(), BiggerBucket(buckets));
+
+			seeds.assign(buckets.size(), 0);
+			slots.assign(lexemes.size(), UNKNOWN);
+
+			//! THE BIGGEST BUCKETS ARE PLACED FIRST, WHILE MOST SLOTS ARE STILL FREE
+			for (size_t b = 0; b < order.size(); b++) {
+				const std::vector<int>& bucket = buckets[order[b]];
+				if (bucket.empty()) {
+					break;
+				}
+
+				std::vector<size_t> taken(bucket.size());
+				for (uint32_t seed = 1; ; seed++) {
+					if (tryPlace(bucket, hashes, seed, taken)) {
+						seeds[order[b]] = seed;
+						for (size_t i = 0; i < bucket.size(); i++) {
+							slots[taken[i]] = bucket[i];
+						}
+						break;
+					}
+				}
+			}
+		}
+
+		bool tryPlace(const std::vector<int>& bucket, const std::vector<uint64_t>& hashes, const uint32_t seed, std::vector<size_t>& taken) const {
+			for (size_t i = 0; i < bucket.size(); i++) {
+				size_t slot = slotHash(hashes[bucket[i]], seed) % slots.size();
+				if (slots[slot] != UNKNOWN || std::find(taken.begin(), taken.begin() + i, slot) != taken.begin() + i) {
+					return false;
+				}
+				taken[i] = slot;
+			}
+			return true;
+		}
+
+		struct BiggerBucket {
+			const std::vector<std::vector<int>>& buckets;
+
+			explicit BiggerBucket(const std::vector<std::vector<int>>& bucketsInput) : buckets(bucketsInput) {}
+
+			bool operator()(const size_t a, const size_t b) const {
+				return buckets[a].size() > buckets[b].size();
+			}
+		};
+};
+
+#endif //TERMINAL_CLASSIFIER_H